@@ -0,0 +1,87 @@
+
+; File: paging_low.asm
+;
+; Low-level register operations for x86 paging subsystem.
+;
+; The functions follow the cdecl convention: arguments on the stack,
+; return value in eax.
+
+; ----------------------------------------------------------------------
+; read_cr0()
+;
+; Returns the value of control register CR0.
+;
+; ----------------------------------------------------------------------
+global _read_cr0
+_read_cr0:
+	mov eax, cr0
+	ret
+
+; ----------------------------------------------------------------------
+; write_cr0(unsigned long _val)
+;
+; Stores _val in control register CR0. Setting bit 31 turns paging on.
+;
+; ----------------------------------------------------------------------
+global _write_cr0
+_write_cr0:
+	mov eax, [esp+4]
+	mov cr0, eax
+	ret
+
+; ----------------------------------------------------------------------
+; read_cr2()
+;
+; Returns the value of control register CR2 (page fault address).
+;
+; ----------------------------------------------------------------------
+global _read_cr2
+_read_cr2:
+	mov eax, cr2
+	ret
+
+; ----------------------------------------------------------------------
+; read_cr3()
+;
+; Returns the value of control register CR3 (page directory base).
+;
+; ----------------------------------------------------------------------
+global _read_cr3
+_read_cr3:
+	mov eax, cr3
+	ret
+
+; ----------------------------------------------------------------------
+; write_cr3(unsigned long _val)
+;
+; Stores _val in control register CR3. This also flushes the TLB.
+;
+; ----------------------------------------------------------------------
+global _write_cr3
+_write_cr3:
+	mov eax, [esp+4]
+	mov cr3, eax
+	ret
+
+; ----------------------------------------------------------------------
+; read_cr4()
+;
+; Returns the value of control register CR4.
+;
+; ----------------------------------------------------------------------
+global _read_cr4
+_read_cr4:
+	mov eax, cr4
+	ret
+
+; ----------------------------------------------------------------------
+; write_cr4(unsigned long _val)
+;
+; Stores _val in control register CR4. Bit 4 (PSE) enables 4 MB pages.
+;
+; ----------------------------------------------------------------------
+global _write_cr4
+_write_cr4:
+	mov eax, [esp+4]
+	mov cr4, eax
+	ret
@@ -0,0 +1,60 @@
+#!/bin/sh
+#
+# File: perf_compare.sh
+#
+# Author: Daniel Choi
+# Date  : 3/29/2025
+#
+# Compares the BENCH lines of a kernel run against a baseline (see "make
+# perf"). Usage:
+#
+#   perf_compare.sh <baseline> <log> <threshold in percent>
+#
+# A benchmark regresses if it got worse by more than the threshold: cycles
+# per operation went up, or MB/s (lines that end in "MB/s") went down.
+# Fails if any benchmark regressed or is missing from the log. Benchmarks
+# that are not in the baseline yet are listed, but do not fail. An empty
+# baseline fails too, so that a missing baseline cannot pass as "no
+# regressions".
+
+if [ $# -ne 3 ]; then
+    echo "usage: $0 <baseline> <log> <threshold in percent>" >&2
+    exit 2
+fi
+
+awk -v threshold="$3" '
+    FILENAME == ARGV[1] {
+        if ($1 == "BENCH") { base[$2] = $3; bandwidth[$2] = ($4 == "MB/s"); n_base++ }
+        next
+    }
+    $1 == "BENCH" {
+        seen[$2] = 1
+        n_runs++
+        if (!($2 in base)) {
+            printf "%-28s %12s %12d      new\n", $2, "-", $3
+            next
+        }
+        change = base[$2] ? ($3 - base[$2]) * 100.0 / base[$2] : 0
+        worse = bandwidth[$2] ? -change : change
+        status = worse > threshold ? "REGRESSED" : (worse < -threshold ? "improved" : "ok")
+        if (status == "REGRESSED") failed = 1
+        printf "%-28s %12d %12d %+7.1f%%  %s\n", $2, base[$2], $3, change, status
+    }
+    END {
+        for (name in base) {
+            if (!(name in seen)) {
+                printf "%-28s %12d %12s      MISSING\n", name, base[name], "-"
+                failed = 1
+            }
+        }
+        if (n_runs == 0) {
+            print "no BENCH lines in the log"
+            failed = 1
+        }
+        if (n_base == 0) {
+            print "no BENCH lines in the baseline, record one with make perf-baseline"
+            failed = 1
+        }
+        exit failed
+    }
+' "$1" "$2"
@@ -43,10 +43,158 @@ mboot:
 ; will insert an 'extern _main', followed by 'call _main', right
 ; before the 'jmp $'.
 stublet:
+    call enable_sse
     extern _main
     call _main
     jmp $
 
+; ----------------------------------------------------------------------
+; FPU AND SSE
+;
+; The CPU comes up with SSE off: any SSE instruction raises #UD until
+; the OS says (CR4.OSFXSR) that it knows about the SSE registers. We
+; turn it on if CPUID says the CPU has SSE2, and tell the kernel in
+; _sse_enabled. Unmasked SIMD exceptions are reported as #XM
+; (CR4.OSXMMEXCPT), not as #UD.
+; ----------------------------------------------------------------------
+
+CR0_MP          equ 1 << 1      ; WAIT/FWAIT honours CR0.TS
+CR0_EM          equ 1 << 2      ; FPU emulation; must be off for SSE
+CR4_OSFXSR      equ 1 << 9
+CR4_OSXMMEXCPT  equ 1 << 10
+CPUID_1_SSE2    equ 1 << 26     ; in EDX
+
+enable_sse:
+    mov eax, 1
+    cpuid
+    test edx, CPUID_1_SSE2
+    jz .done
+
+    mov eax, cr0
+    and eax, ~CR0_EM
+    or eax, CR0_MP
+    mov cr0, eax
+    mov eax, cr4
+    or eax, CR4_OSFXSR | CR4_OSXMMEXCPT
+    mov cr4, eax
+    fninit
+
+    mov dword [_sse_enabled], 1
+.done:
+    ret
+
+; ----------------------------------------------------------------------
+; EXCEPTION SERVICE ROUTINES
+;
+; One stub per CPU exception 0 - 31. The CPU pushes an error code for
+; exceptions 8, 10 - 14, 17, 21, 29 and 30 only. For all others we push
+; a dummy 0, so that the stack looks the same (struct REGS in machine.H)
+; by the time we reach the common stub.
+; ----------------------------------------------------------------------
+
+%macro ISR_NOERRCODE 1
+isr%1:
+    push byte 0             ; dummy error code
+    push byte %1            ; exception number
+    jmp isr_common_stub
+%endmacro
+
+%macro ISR_ERRCODE 1
+isr%1:
+                            ; the CPU has pushed the error code already
+    push byte %1            ; exception number
+    jmp isr_common_stub
+%endmacro
+
+ISR_NOERRCODE 0
+ISR_NOERRCODE 1
+ISR_NOERRCODE 2
+ISR_NOERRCODE 3
+ISR_NOERRCODE 4
+ISR_NOERRCODE 5
+ISR_NOERRCODE 6
+ISR_NOERRCODE 7
+ISR_ERRCODE   8
+ISR_NOERRCODE 9
+ISR_ERRCODE   10
+ISR_ERRCODE   11
+ISR_ERRCODE   12
+ISR_ERRCODE   13
+ISR_ERRCODE   14
+ISR_NOERRCODE 15
+ISR_NOERRCODE 16
+ISR_ERRCODE   17
+ISR_NOERRCODE 18
+ISR_NOERRCODE 19
+ISR_NOERRCODE 20
+ISR_ERRCODE   21
+ISR_NOERRCODE 22
+ISR_NOERRCODE 23
+ISR_NOERRCODE 24
+ISR_NOERRCODE 25
+ISR_NOERRCODE 26
+ISR_NOERRCODE 27
+ISR_NOERRCODE 28
+ISR_ERRCODE   29
+ISR_ERRCODE   30
+ISR_NOERRCODE 31
+
+; Saves the processor state, calls the high-level dispatcher with a
+; pointer to the saved state (struct REGS), and restores the state.
+; With SSE on, the handlers may use the XMM registers themselves (the
+; page fault handler calls memset/memcpy), so the FPU/SSE state of the
+; interrupted code is saved as well, in a 16-byte aligned area on the
+; stack below REGS.
+extern _dispatch_exception
+isr_common_stub:
+    pusha
+    push ds
+    push es
+    push fs
+    push gs
+    mov eax, esp            ; REGS * is the top of the stack
+    mov ebx, esp            ; ebx is restored by popa below
+    sub esp, 512
+    and esp, 0xFFFFFFF0     ; fxsave needs a 16-byte aligned area
+    cmp dword [_sse_enabled], 0
+    je .saved
+    fxsave [esp]
+.saved:
+    push ebx
+    push eax
+    call _dispatch_exception
+    pop eax
+    pop ebx
+    cmp dword [_sse_enabled], 0
+    je .restored
+    fxrstor [esp]
+.restored:
+    mov esp, ebx
+    pop gs
+    pop fs
+    pop es
+    pop ds
+    popa
+    add esp, 8              ; drop exception number and error code
+    iret
+
+; Addresses of the stubs above, used by the exception dispatcher to
+; fill in the IDT.
+SECTION .data
+global _sse_enabled
+_sse_enabled:
+    dd 0
+
+global _isr_stub_table
+_isr_stub_table:
+%assign i 0
+%rep 32
+    dd isr%+i
+%assign i i+1
+%endrep
+
+SECTION .text
+
 ; Here is the definition of our BSS section. Right now, we'll use
 ; it just to store the stack. Remember that a stack actually grows
 ; downwards, so we declare the size of the data before declaring